@@ -1,7 +1,8 @@
 #include <card.h>
+#include <random.h>
 
 #include <algorithm>
-#include <random>
+#include <span>
 #include <vector>
 
 bool Cards::registerCard(Card&& card) {
@@ -19,51 +20,73 @@ CardsDueDates::CardsDueDates() {
 }
 
 void CardsDueDates::addDueCard(CardReference card, int numberOfDaysSinceLastTime) {
-  mDueCards.push_back({card, numberOfDaysSinceLastTime});
+  mDueCards.push_back({card, numberOfDaysSinceLastTime, 0});
   mDirty = true;
 }
 
 void CardsDueDates::addCard(CardReference card, const std::chrono::year_month_day& dueDate, int numberOfDaysSinceLastTime) {
   if (dueDate <= mToday) {
-    mDueCards.push_back({card, numberOfDaysSinceLastTime});
+    int numberOfDaysOverdue = static_cast<int>((std::chrono::sys_days(mToday) - std::chrono::sys_days(dueDate)).count());
+    mDueCards.push_back({card, numberOfDaysSinceLastTime, numberOfDaysOverdue});
     mDirty |= (dueDate < mToday);
   } else {
     mOtherCards.insert({dueDate, card, numberOfDaysSinceLastTime});
   }
 }
 
-std::optional<std::list<std::pair<CardReference, int>>::iterator> CardsDueDates::pickNewCard() {
-  if (!mDueCards.empty()) {
-    return std::make_optional(mDueCards.begin());
-  } else {
-    return decltype(std::make_optional(mDueCards.begin())){};
-  }
+const DueCard* CardsDueDates::pickNewCard() const {
+  return mDueCards.empty() ? nullptr : &mDueCards.front();
+}
+
+const DueCard* CardsDueDates::peekNextCard() const {
+  return (mDueCards.size() > 1) ? &mDueCards[1] : nullptr;
 }
 
-void CardsDueDates::putbackCard(std::list<std::pair<CardReference, int>>::iterator it, int nextDueDays) {
+void CardsDueDates::putbackCard(int nextDueDays) {
+  DueCard dueCard = mDueCards.front();
+  mDueCards.pop_front();
   if (nextDueDays <= 0) {
-    it->second = 0;
-    mDueCards.splice(mDueCards.cend(), mDueCards, it);
+    dueCard.numberOfDaysSinceLastTime = 0;
+    dueCard.numberOfDaysOverdue = 0;
+    mDueCards.push_back(dueCard);
   } else {
     std::chrono::year_month_day dueDate = static_cast<std::chrono::sys_days>(mToday) + std::chrono::days(nextDueDays);
-    mOtherCards.insert({dueDate, it->first, nextDueDays});
-    mDueCards.erase(it);
+    mOtherCards.insert({dueDate, dueCard.card, nextDueDays});
     mDirty = true;
   }
 }
 
-void CardsDueDates::shuffleDueCards() {
-  std::vector<decltype(mDueCards.cbegin())> iterators{};
-  iterators.reserve(mDueCards.size());
-  for (auto it = mDueCards.cbegin(); it != mDueCards.cend(); ++it) {
-    iterators.push_back(it);
-  }
-
-  std::mt19937 randomGenerator{std::random_device{}()};
-  std::shuffle(iterators.begin(), iterators.end(), randomGenerator);
+void CardsDueDates::orderDueCards(DueCardsOrder order, std::uint64_t seed) {
+  std::span<DueCard> dueCards = mDueCards.linearize();
+  RandomGenerator randomGenerator{seed};
+  randomShuffle(dueCards.begin(), dueCards.end(), randomGenerator);
 
-  for (auto it : iterators) {
-    mDueCards.splice(mDueCards.cend(), mDueCards, it);
+  switch (order) {
+    case DueCardsOrder::Random:
+      break;
+    case DueCardsOrder::MostOverdue:
+      std::stable_sort(dueCards.begin(), dueCards.end(), [](const DueCard& a, const DueCard& b) {
+        return a.numberOfDaysOverdue > b.numberOfDaysOverdue;
+      });
+      break;
+    case DueCardsOrder::ShortestInterval:
+      // New cards have no interval yet, they come last
+      std::stable_sort(dueCards.begin(), dueCards.end(), [](const DueCard& a, const DueCard& b) {
+        return static_cast<unsigned int>(a.numberOfDaysSinceLastTime) < static_cast<unsigned int>(b.numberOfDaysSinceLastTime);
+      });
+      break;
+    case DueCardsOrder::Interleaved: {
+      auto newCards = std::stable_partition(dueCards.begin(), dueCards.end(), [](const DueCard& dueCard) {
+        return dueCard.numberOfDaysSinceLastTime >= 0;
+      });
+      std::vector<DueCard> interleaved;
+      interleaved.reserve(dueCards.size());
+      for (auto reviewIt = dueCards.begin(), newIt = newCards; reviewIt != newCards || newIt != dueCards.end();) {
+        if (reviewIt != newCards) interleaved.push_back(*reviewIt++);
+        if (newIt != dueCards.end()) interleaved.push_back(*newIt++);
+      }
+      std::copy(interleaved.begin(), interleaved.end(), dueCards.begin());
+      break;
+    }
   }
 }
-
@@ -1,12 +1,13 @@
 #ifndef CARD_H
 #define CARD_H
 
+#include "ring_buffer.h"
+
 #include <chrono>
+#include <cstdint>
 #include <set>
 #include <string>
 #include <string_view>
-#include <list>
-#include <optional>
 #include <unordered_set>
 #include <tuple>
 
@@ -39,6 +40,14 @@ struct CardTitleHash {
 
 using CardReference = std::reference_wrapper<const Card>;
 
+struct DueCard {
+  CardReference card;
+  int numberOfDaysSinceLastTime;
+  int numberOfDaysOverdue;
+};
+
+enum class DueCardsOrder {Random, MostOverdue, ShortestInterval, Interleaved};
+
 class Cards {
   std::unordered_set<Card, CardTitleHash, CardTitleEqual> mCards;
 
@@ -61,7 +70,7 @@ class CardsDueDates {
     }
   };
 
-  std::list<std::pair<CardReference, int>> mDueCards;
+  RingBuffer<DueCard> mDueCards;
   std::multiset<Type, SetCompare> mOtherCards;
   std::chrono::year_month_day mToday;
   bool mDirty = false;
@@ -76,9 +85,15 @@ public:
 
   void addDueCard(CardReference card, int numberOfDaysSinceLastTime);
   void addCard(CardReference card, const std::chrono::year_month_day& dueDate, int numberOfDaysSinceLastTime = 0);
-  std::optional<std::list<std::pair<CardReference, int>>::iterator> pickNewCard();
-  void putbackCard(std::list<std::pair<CardReference, int>>::iterator it, int nextDueDays);
-  void shuffleDueCards();
+  // The picked card stays first in the due cards until it is put back.
+  const DueCard* pickNewCard() const;
+  // The card picked after the current one is put back, unless it is the only due card.
+  const DueCard* peekNextCard() const;
+  void putbackCard(int nextDueDays);
+  // Cards which are equal for `order` are shuffled, the same way for a given `seed`. The cards put back for today by
+  // `putbackCard` are not reordered, they go to the end: with `Interleaved`, the end of a session can be a run of new
+  // cards shown again instead of an alternation.
+  void orderDueCards(DueCardsOrder order, std::uint64_t seed);
 };
 
 #endif
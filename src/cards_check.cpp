@@ -0,0 +1,316 @@
+#include "cards_check.h"
+#include "compressed_stream.h"
+#include "file.h"
+#include "json_io.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+#include "rapidjson/error/en.h"
+#include "rapidjson/error/error.h"
+#include "rapidjson/reader.h"
+
+namespace {
+
+struct Entry {
+  std::string title;
+  std::size_t offset;
+};
+
+struct FileCheck {
+  const char* path;
+  std::vector<Entry> entries;
+  std::vector<CheckError> errors;
+
+  void addError(std::size_t offset, std::string&& message) {errors.push_back({path, offset, std::move(message)});}
+};
+
+// `writeCardsDueDates` writes the titles as is between quotes
+bool needsEscaping(const char* str, rapidjson::SizeType length) {
+  return std::any_of(str, str+length, [](char c) {return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;});
+}
+
+// The SAX callbacks only come once a token has been read, so remember where the last string started to report the
+// errors about a key or a string value at its opening quote.
+class OffsetTrackingStream {
+  CompressedReadStream& mStream;
+  std::size_t mStringOffset = 0;
+  bool mIsInString = false;
+  bool mIsEscaped = false;
+
+public:
+  typedef char Ch;
+
+  explicit OffsetTrackingStream(CompressedReadStream& stream) : mStream(stream) {}
+
+  Ch Peek() const {return mStream.Peek();}
+  std::size_t Tell() const {return mStream.Tell();}
+  std::size_t stringOffset() const {return mStringOffset;}
+
+  Ch Take() {
+    Ch c = mStream.Take();
+    if (mIsInString) {
+      if (mIsEscaped) mIsEscaped = false;
+      else if (c == '\\') mIsEscaped = true;
+      else if (c == '"') mIsInString = false;
+    } else if (c == '"') {
+      mIsInString = true;
+      mStringOffset = mStream.Tell() - 1;
+    }
+    return c;
+  }
+
+  // Not implemented
+  void Put(Ch) {assert(false);}
+  void Flush() {assert(false);}
+  Ch* PutBegin() {assert(false); return nullptr;}
+  std::size_t PutEnd(Ch*) {assert(false); return 0;}
+};
+
+// Instead of stopping at the first error, the checkers report unexpected containers once and skip their content
+class CheckerBase {
+  const OffsetTrackingStream& mStream;
+  FileCheck& mCheck;
+  int mSkippedDepth = 0;
+
+protected:
+  int mDepth = 0;
+
+  bool isSkipping() const {return mSkippedDepth > 0;}
+  void addError(std::string&& message) {mCheck.addError(mStream.Tell(), std::move(message));}
+  // For errors about the key or string value which was just read
+  void addStringError(std::string&& message) {mCheck.addError(mStream.stringOffset(), std::move(message));}
+
+  bool startContainer(bool isExpected) {
+    ++mDepth;
+    if (!isSkipping() && !isExpected) {
+      addError("Unexpected element type");
+      mSkippedDepth = mDepth;
+    }
+    return true;
+  }
+
+  bool endContainer() {
+    if (mSkippedDepth == mDepth) mSkippedDepth = 0;
+    --mDepth;
+    return true;
+  }
+
+  void startEntry(const char* title, rapidjson::SizeType length) {
+    mCheck.entries.push_back({std::string{title, length}, mStream.stringOffset()});
+    if (length == 0) addStringError("Empty key");
+  }
+
+public:
+  CheckerBase(const OffsetTrackingStream& stream, FileCheck& check) : mStream(stream), mCheck(check) {}
+
+  bool Default() {
+    if (!isSkipping()) addError("Unexpected element type");
+    return true;
+  }
+};
+
+class CardsChecker : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, CardsChecker>, public CheckerBase {
+public:
+  using CheckerBase::CheckerBase;
+  using CheckerBase::Default;
+
+  bool String([[maybe_unused]] const char* str, rapidjson::SizeType length, [[maybe_unused]] bool copy) {
+    if (isSkipping()) return true;
+    if (mDepth != 2) return Default();
+    if (length == 0) addStringError("Empty card side");
+    return true;
+  }
+
+  bool StartObject() {return startContainer(mDepth == 0);}
+  bool EndObject([[maybe_unused]] rapidjson::SizeType memCount) {return endContainer();}
+
+  bool Key(const char* str, rapidjson::SizeType length, [[maybe_unused]] bool copy) {
+    if (isSkipping() || mDepth != 1) return true;
+    startEntry(str, length);
+    if (needsEscaping(str, length)) addStringError("Title contains characters that must be escaped");
+    return true;
+  }
+
+  bool StartArray() {return startContainer(mDepth == 1);}
+
+  bool EndArray(rapidjson::SizeType numElement) {
+    if (!isSkipping() && mDepth == 2 && numElement != rapidjson::SizeType(2)) addError("Card can only have 2 sides");
+    return endContainer();
+  }
+};
+
+class CardsDueDatesChecker : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, CardsDueDatesChecker>, public CheckerBase {
+  rapidjson::SizeType mElementIndex = 0;
+
+  rapidjson::SizeType nextElement() {return (mDepth == 2) ? mElementIndex++ : 0;}
+
+public:
+  using CheckerBase::CheckerBase;
+
+  bool Default() {
+    nextElement();
+    return CheckerBase::Default();
+  }
+
+  bool String(const char* str, rapidjson::SizeType length, [[maybe_unused]] bool copy) {
+    if (isSkipping()) return true;
+    if (mDepth == 0 || nextElement() != 0) return CheckerBase::Default();
+    if (!stringToYmd(str, length).has_value()) addStringError("Invalid date");
+    return true;
+  }
+
+  bool Uint(unsigned u) {
+    if (isSkipping()) return true;
+    if (mDepth != 2 || nextElement() != 1) return CheckerBase::Default();
+    if (u > (unsigned int)std::numeric_limits<int>::max()) addError("Integer too large");
+    return true;
+  }
+
+  bool StartObject() {
+    nextElement();
+    return startContainer(mDepth == 0);
+  }
+
+  bool EndObject([[maybe_unused]] rapidjson::SizeType memCount) {return endContainer();}
+
+  bool Key(const char* str, rapidjson::SizeType length, [[maybe_unused]] bool copy) {
+    if (!isSkipping() && mDepth == 1) startEntry(str, length);
+    return true;
+  }
+
+  bool StartArray() {
+    if (mDepth == 1) mElementIndex = 0;
+    else nextElement();
+    return startContainer(mDepth == 1);
+  }
+
+  bool EndArray(rapidjson::SizeType length) {
+    if (!isSkipping() && mDepth == 2 && length != 2) addError("Array must have 2 elements");
+    return endContainer();
+  }
+};
+
+// Return whether the whole file was parsed, that is whether `check.entries` has all the entries of the file
+template<typename Checker>
+bool checkFile(FileCheck& check) {
+  File fp{check.path, "rb"};
+  char readBuffer[65536];
+  CompressedReadStream compressedStream{fp.getHandle(), compressionFromPath(check.path), readBuffer, sizeof(readBuffer)};
+  OffsetTrackingStream is{compressedStream};
+
+  Checker handler{is, check};
+  rapidjson::Reader reader;
+  rapidjson::ParseResult result = reader.Parse(is, handler);
+  if (ferror(fp.getHandle())) {
+    throw std::runtime_error(std::format("Error while reading json file {}!", check.path));
+  }
+  if (result.IsError()) {
+    check.addError(result.Offset(), rapidjson::GetParseError_En(result.Code()));
+  }
+  fp.close();
+  return !result.IsError();
+}
+
+using TitleShards = std::vector<std::unordered_map<std::string_view, std::size_t>>;
+
+// Report the titles present more than once. Each thread handles the titles of one shard, chosen by their hash.
+TitleShards checkDuplicates(FileCheck& check) {
+  const std::vector<Entry>& entries = check.entries;
+  std::size_t threadCount = getThreadCount(entries.size());
+
+  std::vector<std::size_t> hashes(entries.size());
+  parallelFor(entries.size(), threadCount, [&]([[maybe_unused]] std::size_t chunk, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      hashes[i] = std::hash<std::string_view>{}(entries[i].title);
+    }
+  });
+
+  // Bucket the entries once so that each thread only goes through the entries of its shard, in file order
+  std::vector<std::vector<std::size_t>> shardEntries(threadCount);
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (!entries[i].title.empty()) shardEntries[hashes[i] % threadCount].push_back(i);
+  }
+
+  TitleShards shards(threadCount);
+  std::vector<std::vector<CheckError>> shardErrors(threadCount);
+  parallelFor(threadCount, threadCount, [&](std::size_t shard, [[maybe_unused]] std::size_t begin, [[maybe_unused]] std::size_t end) {
+    shards[shard].reserve(shardEntries[shard].size());
+    for (std::size_t i : shardEntries[shard]) {
+      if (!shards[shard].emplace(entries[i].title, entries[i].offset).second) {
+        shardErrors[shard].push_back({check.path, entries[i].offset, std::format("Card `{}` is already present", entries[i].title)});
+      }
+    }
+  });
+
+  for (auto& errors : shardErrors) {
+    check.errors.insert(check.errors.end(), std::make_move_iterator(errors.begin()), std::make_move_iterator(errors.end()));
+  }
+  return shards;
+}
+
+void checkOrphans(FileCheck& check, const TitleShards& cardsTitles) {
+  const std::vector<Entry>& entries = check.entries;
+  std::size_t threadCount = getThreadCount(entries.size());
+
+  std::vector<std::vector<CheckError>> chunkErrors(threadCount);
+  parallelFor(entries.size(), threadCount, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      std::string_view title = entries[i].title;
+      if (title.empty()) continue;
+      if (!cardsTitles[std::hash<std::string_view>{}(title) % cardsTitles.size()].contains(title)) {
+        chunkErrors[chunk].push_back({check.path, entries[i].offset, std::format("Card `{}` is not present", title)});
+      }
+    }
+  });
+
+  for (auto& errors : chunkErrors) {
+    check.errors.insert(check.errors.end(), std::make_move_iterator(errors.begin()), std::make_move_iterator(errors.end()));
+  }
+}
+
+} // namespace
+
+std::vector<CheckError> checkCardsFiles(const char* cardsPath, const char* cardsDueDatesPath) {
+  FileCheck cardsCheck{cardsPath, {}, {}};
+  FileCheck dueDatesCheck{cardsDueDatesPath, {}, {}};
+
+  // A compressed stream can only be decoded from its start, so each file is parsed by a single thread. The two files
+  // are parsed at the same time and the checks on the parsed entries are parallel.
+  std::future<bool> dueDatesCheckResult = std::async(std::launch::async, [&dueDatesCheck] {
+    try {
+      checkFile<CardsDueDatesChecker>(dueDatesCheck);
+      return true;
+    } catch (const FileNotFoundException&) {
+      return false;
+    }
+  });
+  bool isCardsParsed = checkFile<CardsChecker>(cardsCheck);
+  bool hasDueDates = dueDatesCheckResult.get();
+
+  TitleShards cardsTitles = checkDuplicates(cardsCheck);
+  if (hasDueDates) {
+    checkDuplicates(dueDatesCheck);
+    // The cards after a syntax error are unknown, their due dates would all be reported
+    if (isCardsParsed) {
+      checkOrphans(dueDatesCheck, cardsTitles);
+    } else {
+      std::cout << "Cards file not parsed completely, due dates of missing cards not checked!" << std::endl;
+    }
+  } else {
+    std::cout << "Cards due dates file not found!" << std::endl;
+  }
+
+  std::vector<CheckError> errors;
+  for (FileCheck* check : {&cardsCheck, &dueDatesCheck}) {
+    std::stable_sort(check->errors.begin(), check->errors.end(), [](const auto& a, const auto& b) {return a.offset < b.offset;});
+    errors.insert(errors.end(), std::make_move_iterator(check->errors.begin()), std::make_move_iterator(check->errors.end()));
+  }
+  return errors;
+}
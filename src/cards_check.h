@@ -0,0 +1,21 @@
+#ifndef CARDS_CHECK_H
+#define CARDS_CHECK_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct CheckError {
+  const char* path;
+  // Byte offset, in the decompressed file, of the opening quote of the entry's title for duplicates and missing cards,
+  // of the opening quote of the string for errors about a key or a string value, and just after the offending token
+  // otherwise
+  std::size_t offset;
+  std::string message;
+};
+
+// Check the cards and cards due dates files, collecting every error instead of stopping at the first one.
+// The errors of the cards come first, each file sorted by offset.
+std::vector<CheckError> checkCardsFiles(const char* cardsPath, const char* cardsDueDatesPath);
+
+#endif
@@ -0,0 +1,131 @@
+#include "cards_index.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+char foldCase(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::uint32_t trigramAt(const char* str) {
+  return (std::uint32_t{static_cast<unsigned char>(str[0])} << 16)
+    | (std::uint32_t{static_cast<unsigned char>(str[1])} << 8)
+    | std::uint32_t{static_cast<unsigned char>(str[2])};
+}
+
+} // namespace
+
+CardsIndex::CardsIndex(const Cards& cards) {
+  for (const Card& card : cards) {
+    mCards.push_back(&card);
+  }
+  if (mCards.size() >= std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("Too many cards to index!");
+  }
+
+  mTextOffsets.resize(mCards.size() + 1);
+  mTextOffsets[0] = 0;
+  for (std::size_t id = 0; id < mCards.size(); ++id) {
+    const Card& card = *mCards[id];
+    mTextOffsets[id+1] = mTextOffsets[id] + card.title().size() + card.firstSide().size() + card.secondSide().size() + 3;
+  }
+  mTexts.resize(mTextOffsets.back());
+
+  // Each thread indexes a contiguous range of cards, so appending the postings of every chunk in order keeps them sorted
+  std::size_t threadCount = getThreadCount(mCards.size());
+  std::vector<std::vector<Postings>> chunkShards(threadCount, std::vector<Postings>(threadCount));
+  parallelFor(mCards.size(), threadCount, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    std::vector<std::uint32_t> trigrams;
+    for (std::size_t id = begin; id < end; ++id) {
+      const Card& card = *mCards[id];
+      char* out = mTexts.data() + mTextOffsets[id];
+      for (const std::string* field : {&card.title(), &card.firstSide(), &card.secondSide()}) {
+        out = std::transform(field->begin(), field->end(), out, foldCase);
+        *out++ = '\0';
+      }
+
+      std::string_view cardText = text(static_cast<std::uint32_t>(id));
+      trigrams.clear();
+      for (std::size_t i = 0; i + 3 <= cardText.size(); ++i) {
+        if (cardText[i] == '\0' || cardText[i+1] == '\0' || cardText[i+2] == '\0') continue;
+        trigrams.push_back(trigramAt(&cardText[i]));
+      }
+      std::sort(trigrams.begin(), trigrams.end());
+      trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+      for (std::uint32_t trigram : trigrams) {
+        chunkShards[chunk][trigram % threadCount][trigram].push_back(static_cast<std::uint32_t>(id));
+      }
+    }
+  });
+
+  mShards.resize(threadCount);
+  parallelFor(threadCount, threadCount, [&](std::size_t shard, [[maybe_unused]] std::size_t begin, [[maybe_unused]] std::size_t end) {
+    for (std::size_t chunk = 0; chunk < threadCount; ++chunk) {
+      for (auto& [trigram, ids] : chunkShards[chunk][shard]) {
+        auto& postings = mShards[shard][trigram];
+        postings.insert(postings.end(), ids.begin(), ids.end());
+      }
+      chunkShards[chunk][shard].clear();
+    }
+  });
+}
+
+std::vector<const Card*> CardsIndex::search(std::string_view query) const {
+  std::string foldedQuery(query.size(), '\0');
+  std::transform(query.begin(), query.end(), foldedQuery.begin(), foldCase);
+  if (foldedQuery.empty()) return {};
+
+  std::vector<std::uint32_t> candidates;
+  if (foldedQuery.size() < 3) {
+    candidates.resize(mCards.size());
+    std::iota(candidates.begin(), candidates.end(), std::uint32_t{0});
+  } else {
+    std::vector<std::uint32_t> trigrams;
+    for (std::size_t i = 0; i + 3 <= foldedQuery.size(); ++i) {
+      trigrams.push_back(trigramAt(&foldedQuery[i]));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    std::vector<const std::vector<std::uint32_t>*> postingsList;
+    for (std::uint32_t trigram : trigrams) {
+      const Postings& shard = mShards[trigram % mShards.size()];
+      auto it = shard.find(trigram);
+      if (it == shard.end()) return {};
+      postingsList.push_back(&it->second);
+    }
+
+    // Intersect starting from the rarest trigram to keep the candidates small
+    std::sort(postingsList.begin(), postingsList.end(), [](auto* a, auto* b) {return a->size() < b->size();});
+    candidates = *postingsList.front();
+    std::vector<std::uint32_t> intersection;
+    for (auto it = std::next(postingsList.begin()); it != postingsList.end() && !candidates.empty(); ++it) {
+      intersection.clear();
+      std::set_intersection(candidates.begin(), candidates.end(), (*it)->begin(), (*it)->end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+  }
+
+  // Trigrams only give candidates, the actual match is verified with a memchr/memcmp based search on the folded text
+  std::size_t threadCount = getThreadCount(candidates.size());
+  std::vector<std::vector<const Card*>> chunkResults(threadCount);
+  parallelFor(candidates.size(), threadCount, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (text(candidates[i]).find(foldedQuery) != std::string_view::npos) {
+        chunkResults[chunk].push_back(mCards[candidates[i]]);
+      }
+    }
+  });
+
+  std::vector<const Card*> results;
+  for (const auto& chunk : chunkResults) {
+    results.insert(results.end(), chunk.begin(), chunk.end());
+  }
+  std::sort(results.begin(), results.end(), [](const Card* a, const Card* b) {return a->title() < b->title();});
+  return results;
+}
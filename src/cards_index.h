@@ -0,0 +1,34 @@
+#ifndef CARDS_INDEX_H
+#define CARDS_INDEX_H
+
+#include "card.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Trigram inverted index over the titles and both sides of the cards, for ASCII case insensitive substring search.
+class CardsIndex {
+  using Postings = std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>;
+
+  std::vector<const Card*> mCards;
+  // Case folded `title\0firstSide\0secondSide\0` of every card, one after another
+  std::string mTexts;
+  std::vector<std::size_t> mTextOffsets;
+  // Postings sharded by trigram so that they can be merged in parallel
+  std::vector<Postings> mShards;
+
+  std::string_view text(std::uint32_t id) const {
+    return std::string_view{mTexts}.substr(mTextOffsets[id], mTextOffsets[id+1] - mTextOffsets[id]);
+  }
+
+public:
+  explicit CardsIndex(const Cards& cards);
+
+  // Return the cards containing `query`, sorted by title.
+  std::vector<const Card*> search(std::string_view query) const;
+};
+
+#endif
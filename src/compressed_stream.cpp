@@ -0,0 +1,325 @@
+#include "compressed_stream.h"
+
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+#define ZLIB_CONST
+#include <zlib.h>
+#include <zstd.h>
+
+Compression compressionFromPath(std::string_view path) {
+  if (path.ends_with(".gz")) return Compression::Gzip;
+  if (path.ends_with(".zst")) return Compression::Zstd;
+  return Compression::None;
+}
+
+std::string_view compressionExtension(Compression compression) {
+  switch (compression) {
+    case Compression::Gzip: return ".gz";
+    case Compression::Zstd: return ".zst";
+    default: return "";
+  }
+}
+
+class Decoder {
+public:
+  virtual ~Decoder() = default;
+
+  // Fill `out` completely unless the end of the stream is reached. Return the number of bytes written.
+  virtual std::size_t read(char* out, std::size_t size) = 0;
+};
+
+class Encoder {
+public:
+  virtual ~Encoder() = default;
+
+  virtual void write(const char* data, std::size_t size) = 0;
+  virtual void finish() = 0;
+};
+
+namespace {
+
+class PlainDecoder : public Decoder {
+  FILE* mFile;
+
+public:
+  PlainDecoder(FILE* file) : mFile(file) {}
+
+  std::size_t read(char* out, std::size_t size) override {
+    return fread(out, 1, size, mFile);
+  }
+};
+
+class GzipDecoder : public Decoder {
+  FILE* mFile;
+  z_stream mStream{};
+  unsigned char mInput[65536];
+  bool mInputEof = false;
+  bool mStreamEnd = false;
+
+public:
+  GzipDecoder(FILE* file) : mFile(file) {
+    // Accept both gzip and zlib headers
+    if (inflateInit2(&mStream, 15 + 32) != Z_OK) {
+      throw std::runtime_error("Failed to initialize gzip decompression!");
+    }
+  }
+
+  GzipDecoder(const GzipDecoder&) = delete;
+  GzipDecoder& operator=(const GzipDecoder&) = delete;
+
+  ~GzipDecoder() override {
+    inflateEnd(&mStream);
+  }
+
+  std::size_t read(char* out, std::size_t size) override {
+    mStream.next_out = reinterpret_cast<Bytef*>(out);
+    mStream.avail_out = static_cast<uInt>(size);
+    while (mStream.avail_out > 0) {
+      if (mStream.avail_in == 0 && !mInputEof) {
+        std::size_t count = fread(mInput, 1, sizeof(mInput), mFile);
+        mInputEof = count < sizeof(mInput);
+        mStream.next_in = mInput;
+        mStream.avail_in = static_cast<uInt>(count);
+      }
+      if (mStreamEnd) {
+        if (mStream.avail_in == 0) break;
+        // Concatenated gzip members
+        inflateReset(&mStream);
+        mStreamEnd = false;
+      }
+      // An empty file is read as empty, like a plain file, and left to the JSON parser to report
+      if (mInputEof && mStream.avail_in == 0 && mStream.total_in == 0) break;
+
+      int err = inflate(&mStream, Z_NO_FLUSH);
+      if (err == Z_STREAM_END) {
+        mStreamEnd = true;
+      } else if (err == Z_BUF_ERROR) {
+        if (mInputEof && mStream.avail_in == 0) throw std::runtime_error("Truncated gzip stream!");
+      } else if (err != Z_OK) {
+        throw std::runtime_error(std::format("Corrupted gzip stream ({})!", mStream.msg ? mStream.msg : "unknown error"));
+      }
+    }
+    return size - mStream.avail_out;
+  }
+};
+
+class ZstdDecoder : public Decoder {
+  FILE* mFile;
+  ZSTD_DCtx* mContext;
+  std::vector<char> mInput;
+  ZSTD_inBuffer mInputBuffer{nullptr, 0, 0};
+  std::size_t mLastResult = 0;
+  bool mInputEof = false;
+
+public:
+  ZstdDecoder(FILE* file) : mFile(file), mContext(ZSTD_createDCtx()), mInput(ZSTD_DStreamInSize()) {
+    if (mContext == nullptr) {
+      throw std::runtime_error("Failed to initialize zstd decompression!");
+    }
+    mInputBuffer.src = mInput.data();
+  }
+
+  ZstdDecoder(const ZstdDecoder&) = delete;
+  ZstdDecoder& operator=(const ZstdDecoder&) = delete;
+
+  ~ZstdDecoder() override {
+    ZSTD_freeDCtx(mContext);
+  }
+
+  std::size_t read(char* out, std::size_t size) override {
+    ZSTD_outBuffer output{out, size, 0};
+    while (output.pos < output.size) {
+      if (mInputBuffer.pos == mInputBuffer.size && !mInputEof) {
+        mInputBuffer.size = fread(mInput.data(), 1, mInput.size(), mFile);
+        mInputBuffer.pos = 0;
+        mInputEof = mInputBuffer.size < mInput.size();
+      }
+
+      // Once the input is exhausted, only data still buffered by zstd can come out
+      if (mInputEof && mInputBuffer.pos == mInputBuffer.size && mLastResult == 0) break;
+      std::size_t previousPos = output.pos;
+      std::size_t previousInputPos = mInputBuffer.pos;
+      std::size_t result = ZSTD_decompressStream(mContext, &output, &mInputBuffer);
+      if (ZSTD_isError(result)) {
+        throw std::runtime_error(std::format("Corrupted zstd stream ({})!", ZSTD_getErrorName(result)));
+      }
+      if (output.pos == previousPos && mInputBuffer.pos == previousInputPos) {
+        if (mInputEof && mInputBuffer.pos == mInputBuffer.size) throw std::runtime_error("Truncated zstd stream!");
+      } else {
+        mLastResult = result;
+      }
+    }
+    return output.pos;
+  }
+};
+
+class PlainEncoder : public Encoder {
+  FILE* mFile;
+
+public:
+  PlainEncoder(FILE* file) : mFile(file) {}
+
+  void write(const char* data, std::size_t size) override {
+    fwrite(data, 1, size, mFile);
+  }
+
+  void finish() override {}
+};
+
+class GzipEncoder : public Encoder {
+  FILE* mFile;
+  z_stream mStream{};
+  unsigned char mOutput[65536];
+
+  void deflateInput(int flush) {
+    do {
+      mStream.next_out = mOutput;
+      mStream.avail_out = sizeof(mOutput);
+      if (deflate(&mStream, flush) == Z_STREAM_ERROR) {
+        throw std::runtime_error("Error during gzip compression!");
+      }
+      fwrite(mOutput, 1, sizeof(mOutput) - mStream.avail_out, mFile);
+    } while (mStream.avail_out == 0);
+  }
+
+public:
+  GzipEncoder(FILE* file) : mFile(file) {
+    if (deflateInit2(&mStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw std::runtime_error("Failed to initialize gzip compression!");
+    }
+  }
+
+  GzipEncoder(const GzipEncoder&) = delete;
+  GzipEncoder& operator=(const GzipEncoder&) = delete;
+
+  ~GzipEncoder() override {
+    deflateEnd(&mStream);
+  }
+
+  void write(const char* data, std::size_t size) override {
+    mStream.next_in = reinterpret_cast<const Bytef*>(data);
+    mStream.avail_in = static_cast<uInt>(size);
+    deflateInput(Z_NO_FLUSH);
+  }
+
+  void finish() override {
+    mStream.next_in = nullptr;
+    mStream.avail_in = 0;
+    deflateInput(Z_FINISH);
+  }
+};
+
+class ZstdEncoder : public Encoder {
+  FILE* mFile;
+  ZSTD_CCtx* mContext;
+  std::vector<char> mOutput;
+
+  std::size_t compress(ZSTD_inBuffer& input, ZSTD_EndDirective mode) {
+    ZSTD_outBuffer output{mOutput.data(), mOutput.size(), 0};
+    std::size_t result = ZSTD_compressStream2(mContext, &output, &input, mode);
+    if (ZSTD_isError(result)) {
+      throw std::runtime_error(std::format("Error during zstd compression ({})!", ZSTD_getErrorName(result)));
+    }
+    fwrite(mOutput.data(), 1, output.pos, mFile);
+    return result;
+  }
+
+public:
+  ZstdEncoder(FILE* file) : mFile(file), mContext(ZSTD_createCCtx()), mOutput(ZSTD_CStreamOutSize()) {
+    if (mContext == nullptr) {
+      throw std::runtime_error("Failed to initialize zstd compression!");
+    }
+    ZSTD_CCtx_setParameter(mContext, ZSTD_c_compressionLevel, 3);
+  }
+
+  ZstdEncoder(const ZstdEncoder&) = delete;
+  ZstdEncoder& operator=(const ZstdEncoder&) = delete;
+
+  ~ZstdEncoder() override {
+    ZSTD_freeCCtx(mContext);
+  }
+
+  void write(const char* data, std::size_t size) override {
+    ZSTD_inBuffer input{data, size, 0};
+    while (input.pos < input.size) {
+      compress(input, ZSTD_e_continue);
+    }
+  }
+
+  void finish() override {
+    ZSTD_inBuffer input{nullptr, 0, 0};
+    while (compress(input, ZSTD_e_end) != 0) {}
+  }
+};
+
+std::unique_ptr<Decoder> makeDecoder(FILE* file, Compression compression) {
+  switch (compression) {
+    case Compression::Gzip: return std::make_unique<GzipDecoder>(file);
+    case Compression::Zstd: return std::make_unique<ZstdDecoder>(file);
+    default: return std::make_unique<PlainDecoder>(file);
+  }
+}
+
+std::unique_ptr<Encoder> makeEncoder(FILE* file, Compression compression) {
+  switch (compression) {
+    case Compression::Gzip: return std::make_unique<GzipEncoder>(file);
+    case Compression::Zstd: return std::make_unique<ZstdEncoder>(file);
+    default: return std::make_unique<PlainEncoder>(file);
+  }
+}
+
+} // namespace
+
+CompressedReadStream::CompressedReadStream(FILE* file, Compression compression, char* buffer, std::size_t bufferSize)
+  : mDecoder(makeDecoder(file, compression)), mBuffer(buffer), mBufferSize(bufferSize), mBufferLast(buffer), mCurrent(buffer) {
+  assert(bufferSize >= 4);
+  read();
+}
+
+CompressedReadStream::~CompressedReadStream() = default;
+
+void CompressedReadStream::read() {
+  if (mCurrent < mBufferLast) {
+    ++mCurrent;
+  } else if (!mEof) {
+    mCount += mReadCount;
+    mReadCount = mDecoder->read(mBuffer, mBufferSize);
+    mBufferLast = mBuffer + mReadCount - 1;
+    mCurrent = mBuffer;
+
+    if (mReadCount < mBufferSize) {
+      mBuffer[mReadCount] = '\0';
+      ++mBufferLast;
+      mEof = true;
+    }
+  }
+}
+
+CompressedWriteStream::CompressedWriteStream(FILE* file, Compression compression)
+  : mEncoder(makeEncoder(file, compression)) {
+  mBuffer.reserve(65536);
+}
+
+CompressedWriteStream::~CompressedWriteStream() = default;
+
+void CompressedWriteStream::flushBuffer() {
+  mEncoder->write(mBuffer.data(), mBuffer.size());
+  mBuffer.clear();
+}
+
+void CompressedWriteStream::put(char c) {
+  mBuffer.push_back(c);
+  if (mBuffer.size() >= 65536) flushBuffer();
+}
+
+void CompressedWriteStream::write(std::string_view str) {
+  mBuffer.append(str);
+  if (mBuffer.size() >= 65536) flushBuffer();
+}
+
+void CompressedWriteStream::finish() {
+  flushBuffer();
+  mEncoder->finish();
+}
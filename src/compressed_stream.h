@@ -0,0 +1,69 @@
+#ifndef COMPRESSED_STREAM_H
+#define COMPRESSED_STREAM_H
+
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+enum class Compression {None, Gzip, Zstd};
+
+// Guess the compression from the extension of `path` (`.gz` or `.zst`).
+Compression compressionFromPath(std::string_view path);
+std::string_view compressionExtension(Compression compression);
+
+class Decoder;
+class Encoder;
+
+// Rapidjson input stream decompressing `file` on the fly, one buffer at a time.
+class CompressedReadStream {
+  std::unique_ptr<Decoder> mDecoder;
+  char* mBuffer;
+  std::size_t mBufferSize;
+  char* mBufferLast;
+  char* mCurrent;
+  std::size_t mReadCount = 0;
+  std::size_t mCount = 0;
+  bool mEof = false;
+
+  void read();
+
+public:
+  typedef char Ch;
+
+  CompressedReadStream(FILE* file, Compression compression, char* buffer, std::size_t bufferSize);
+  CompressedReadStream(const CompressedReadStream&) = delete;
+  CompressedReadStream& operator=(const CompressedReadStream&) = delete;
+  ~CompressedReadStream();
+
+  Ch Peek() const {return *mCurrent;}
+  Ch Take() {Ch c = *mCurrent; read(); return c;}
+  std::size_t Tell() const {return mCount + static_cast<std::size_t>(mCurrent - mBuffer);}
+
+  // Not implemented
+  void Put(Ch) {assert(false);}
+  void Flush() {assert(false);}
+  Ch* PutBegin() {assert(false); return nullptr;}
+  std::size_t PutEnd(Ch*) {assert(false); return 0;}
+};
+
+// Buffered output stream compressing to `file` on the fly. `finish` must be called to terminate the compressed stream.
+class CompressedWriteStream {
+  std::unique_ptr<Encoder> mEncoder;
+  std::string mBuffer;
+
+  void flushBuffer();
+
+public:
+  CompressedWriteStream(FILE* file, Compression compression);
+  CompressedWriteStream(const CompressedWriteStream&) = delete;
+  CompressedWriteStream& operator=(const CompressedWriteStream&) = delete;
+  ~CompressedWriteStream();
+
+  void put(char c);
+  void write(std::string_view str);
+  void finish();
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef FILE_H
+#define FILE_H
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+struct FileNotFoundException : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+class File {
+  FILE* mFile;
+  const char* mFilename;
+  bool mIsForReading;
+
+  void close(bool shouldThrow) {
+    if (mFile == nullptr) return;
+    int err = fclose(mFile);
+    mFile = nullptr;
+    if (err && shouldThrow) {
+      const char* openMode = (mIsForReading) ? "read" : "write";
+      throw std::runtime_error(std::format("Failed to {} to file {}!", openMode, mFilename));
+    }
+  }
+
+public:
+  File(const char* filename, const char* mode)
+    : mFile(fopen(filename, mode)), mFilename(filename), mIsForReading(mode[0]=='r') {
+    if (mFile == nullptr) {
+      int err = errno;
+      errno = 0;
+      const char* openMode = (mIsForReading) ? "reading" : "writing";
+      std::string msg = std::format("Failed to open file {} for {} ({})!", filename, openMode, std::strerror(err));
+      (err == ENOENT) ? throw FileNotFoundException(msg) : throw std::runtime_error(msg);
+    }
+  }
+
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+
+  ~File() noexcept {
+    close(false);
+  }
+
+  FILE* getHandle() const {return mFile;}
+  void close() {close(true);}
+};
+
+#endif
@@ -1,18 +1,16 @@
 #include "json_io.h"
 
-#include <cerrno>
 #include <charconv>
 #include <chrono>
-#include <cstdio>
 #include <format>
 #include <iostream>
 
+#include "compressed_stream.h"
+#include "file.h"
+
 #include "rapidjson/error/en.h"
 #include "rapidjson/error/error.h"
 #include "rapidjson/reader.h"
-#include "rapidjson/filereadstream.h"
-#include "rapidjson/filewritestream.h"
-#include "rapidjson/prettywriter.h"
 
 std::string ymdToString(const std::chrono::year_month_day& ymd) {
   return std::format("{:%F}", ymd);
@@ -41,48 +39,6 @@ std::optional<std::chrono::year_month_day> stringToYmd(const char* str, std::siz
   return ymd;
 }
 
-struct FileNotFoundException : std::runtime_error {
-  using std::runtime_error::runtime_error;
-};
-
-class File {
-  FILE* mFile;
-  const char* mFilename;
-  bool mIsForReading;
-
-  void close(bool shouldThrow) {
-    if (mFile == nullptr) return;
-    int err = fclose(mFile);
-    mFile = nullptr;
-    if (err && shouldThrow) {
-      const char* openMode = (mIsForReading) ? "read" : "write";
-      throw std::runtime_error(std::format("Failed to {} to file {}!", openMode, mFilename));
-    }
-  }
-
-public:
-  File(const char* filename, const char* mode)
-    : mFile(fopen(filename, mode)), mFilename(filename), mIsForReading(mode[0]=='r') {
-    if (mFile == nullptr) {
-      int err = errno;
-      errno = 0;
-      const char* openMode = (mIsForReading) ? "reading" : "writing";
-      std::string msg = std::format("Failed to open file {} for {} ({})!", filename, openMode, std::strerror(err));
-      (err == ENOENT) ? throw FileNotFoundException(msg) : throw std::runtime_error(msg);
-    }
-  }
-
-  File(const File&) = delete;
-  File& operator=(const File&) = delete;
-
-  ~File() noexcept {
-    close(false);
-  }
-
-  FILE* getHandle() const {return mFile;}
-  void close() {close(true);}
-};
-
 class ReaderBase {
   std::string mError;
 
@@ -199,7 +155,7 @@ public:
   bool addCard() {
     const Card* card = mCards.getCard(mTitle);
     if (card == nullptr) {
-      std::cout << "Card `" << mTitle << "` is not present!" << std::endl;
+      std::cout << "Card `" << mTitle << "` is not present!\n";
     } else {
       using namespace std::chrono;
       mCardsDueDates.addCard(*card, *mYmd, mNumberOfDaysSinceLastTime);
@@ -286,41 +242,42 @@ struct CardsReader : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Card
   }
 };
 
-void writeCardsDueDates(const CardsDueDates& cardsDueDates, FILE* file) {
+void writeCardDueDate(CompressedWriteStream& stream, const std::string& title, const std::string& dueDateStr, int numberOfDaysSinceLastTime) {
+  if (numberOfDaysSinceLastTime < 0) {
+    stream.write(std::format("\"{}\": \"{}\"", title, dueDateStr));
+  } else {
+    stream.write(std::format("\"{}\": [\"{}\", {}]", title, dueDateStr, numberOfDaysSinceLastTime));
+  }
+}
+
+void writeCardsDueDates(const CardsDueDates& cardsDueDates, CompressedWriteStream& stream) {
   std::string dueDateStr = ymdToString(cardsDueDates.getToday());
 
-  fputc('{', file);
+  stream.put('{');
   bool isNotFirstChar = false;
-  for (auto [card, numberOfDaysSinceLastTime] : cardsDueDates.getDueCards()) {
-    if (isNotFirstChar) fputc(',', file);
-    fputc('\n', file);
-    if (numberOfDaysSinceLastTime < 0) {
-      fprintf(file, "\"%s\": \"%s\"", card.get().title().c_str(), dueDateStr.c_str());
-    } else {
-      fprintf(file, "\"%s\": [\"%s\", %i]", card.get().title().c_str(), dueDateStr.c_str(), numberOfDaysSinceLastTime);
-    }
+  for (const auto& [card, numberOfDaysSinceLastTime, _] : cardsDueDates.getDueCards()) {
+    if (isNotFirstChar) stream.put(',');
+    stream.put('\n');
+    writeCardDueDate(stream, card.get().title(), dueDateStr, numberOfDaysSinceLastTime);
     isNotFirstChar = true;
   }
   for (const auto& [dueDate, card, numberOfDaysSinceLastTime] : cardsDueDates.getOtherCards()) {
-    if (isNotFirstChar) fputc(',', file);
-    fputc('\n', file);
+    if (isNotFirstChar) stream.put(',');
+    stream.put('\n');
     dueDateStr = ymdToString(dueDate);
-    if (numberOfDaysSinceLastTime < 0) {
-      fprintf(file, "\"%s\": \"%s\"", card.get().title().c_str(), dueDateStr.c_str());
-    } else {
-      fprintf(file, "\"%s\": [\"%s\", %i]", card.get().title().c_str(), dueDateStr.c_str(), numberOfDaysSinceLastTime);
-    }
+    writeCardDueDate(stream, card.get().title(), dueDateStr, numberOfDaysSinceLastTime);
     isNotFirstChar = true;
   }
-  fputs("\n}", file);
+  stream.write("\n}");
+  stream.finish();
 }
 
 Cards readCards(const char* cardsPath) {
   std::cout << "Reading cards..." << std::endl;
   Cards cards;
-  File fp{cardsPath, "r"};
+  File fp{cardsPath, "rb"};
   char readBuffer[65536];
-  rapidjson::FileReadStream is{fp.getHandle(), readBuffer, sizeof(readBuffer)};
+  CompressedReadStream is{fp.getHandle(), compressionFromPath(cardsPath), readBuffer, sizeof(readBuffer)};
 
   CardsReader handler{cards};
   rapidjson::Reader reader;
@@ -332,10 +289,10 @@ Cards readCards(const char* cardsPath) {
 CardsDueDates readCardsDueDates(const char* cardsDueDatesPath, const Cards& cards, DueDatesStatistics& dueDatesStatistics) {
   CardsDueDates cardsDueDates;
   try {
-    File fp{cardsDueDatesPath, "r"};
+    File fp{cardsDueDatesPath, "rb"};
     std::cout << "Reading cards due dates..." << std::endl;
     char readBuffer[65536];
-    rapidjson::FileReadStream is{fp.getHandle(), readBuffer, sizeof(readBuffer)};
+    CompressedReadStream is{fp.getHandle(), compressionFromPath(cardsDueDatesPath), readBuffer, sizeof(readBuffer)};
 
     CardsDueDatesReader handler{cardsDueDates, cards, dueDatesStatistics};
     rapidjson::Reader reader;
@@ -349,8 +306,9 @@ CardsDueDates readCardsDueDates(const char* cardsDueDatesPath, const Cards& card
 }
 
 void writeCardsDueDate(const char* cardsDueDatesPath, const CardsDueDates& cardsDueDates) {
-  File fp{cardsDueDatesPath, "w"};
-  writeCardsDueDates(cardsDueDates, fp.getHandle());
+  File fp{cardsDueDatesPath, "wb"};
+  CompressedWriteStream stream{fp.getHandle(), compressionFromPath(cardsDueDatesPath)};
+  writeCardsDueDates(cardsDueDates, stream);
   fp.close();
 }
 
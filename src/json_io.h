@@ -4,6 +4,12 @@
 #include "card.h"
 #include "due_dates_statistics.h"
 
+#include <optional>
+
+std::string ymdToString(const std::chrono::year_month_day& ymd);
+// `str` must be null terminated
+std::optional<std::chrono::year_month_day> stringToYmd(const char* str, std::size_t length);
+
 Cards readCards(const char* cardsPath);
 CardsDueDates readCardsDueDates(const char* cardsDueDatesPath, const Cards& cards, DueDatesStatistics& dueDatesStatistics);
 void writeCardsDueDate(const char* cardsDueDatesPath, const CardsDueDates& cardsDueDates);
@@ -1,24 +1,37 @@
 #include "card.h"
+#include "cards_check.h"
+#include "cards_index.h"
+#include "compressed_stream.h"
 #include "json_io.h"
 #include "due_dates_statistics.h"
+#include "terminal_renderer.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <cstdlib>
 #include <filesystem>
+#include <format>
 #include <functional>
 #include <memory>
 #include <new>
 #include <iostream>
 #include <limits>
+#include <optional>
+#include <random>
 #include <signal.h>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 void addNewCardsAndCheckDuplicatesInDueDates(CardsDueDates& cardsDueDates, const Cards& cards, unsigned int allowedNewCardsCount) {
   std::unordered_set<std::string_view> presentCards;
-  for (const auto& [card, _] : cardsDueDates.getDueCards()) {
+  for (const auto& [card, _0, _1] : cardsDueDates.getDueCards()) {
     if (!presentCards.insert(card.get().title()).second) {
       throw std::runtime_error(std::format("Card `{}` is already present", card.get().title()));
     }
@@ -29,28 +42,40 @@ void addNewCardsAndCheckDuplicatesInDueDates(CardsDueDates& cardsDueDates, const
     }
   }
 
+  // Take the new cards by title rather than in hash table order, so that `--seed` gives the same session everywhere
+  std::vector<const Card*> newCards;
   for (const auto& card : cards) {
-    if (!presentCards.contains(card.title())) {
-      cardsDueDates.addDueCard(card, -1);
-      if (--allowedNewCardsCount == 0) break;
-    }
+    if (!presentCards.contains(card.title())) newCards.push_back(&card);
+  }
+  auto newCardsEnd = newCards.begin() + static_cast<std::ptrdiff_t>(std::min<std::size_t>(allowedNewCardsCount, newCards.size()));
+  std::partial_sort(newCards.begin(), newCardsEnd, newCards.end(), [](const Card* a, const Card* b) {return a->title() < b->title();});
+  for (auto it = newCards.begin(); it != newCardsEnd; ++it) {
+    cardsDueDates.addDueCard(**it, -1);
   }
 }
 
-auto readCardsData(const char* cardsPath, const char* cardsDueDatesPath, unsigned int maxNewCardCount) {
+auto readCardsData(const char* cardsPath, const char* cardsDueDatesPath, unsigned int maxNewCardCount, DueCardsOrder order, std::uint64_t seed) {
   Cards cards = readCards(cardsPath);
   DueDatesStatistics dueDatesStatistics;
   CardsDueDates cardsDueDates = readCardsDueDates(cardsDueDatesPath, cards, dueDatesStatistics);
   dueDatesStatistics.print(std::cout);
+  // Shown so that the session can be replayed with `--seed`
+  std::cout << "Graine de l'ordre des cartes: " << seed << std::endl;
   addNewCardsAndCheckDuplicatesInDueDates(cardsDueDates, cards, maxNewCardCount);
-  cardsDueDates.shuffleDueCards();
+  cardsDueDates.orderDueCards(order, seed);
   return std::make_pair(std::move(cards), std::move(cardsDueDates));
 }
 
+enum class Command {Review, Search, Check};
+
 struct CommandLineArguments {
+  Command command = Command::Review;
   std::string cardsPath;
   std::string cardsDueDatesPath;
+  std::string query;
   unsigned int maxNewCardCount = std::numeric_limits<unsigned int>::max();
+  DueCardsOrder order = DueCardsOrder::Random;
+  std::optional<std::uint64_t> seed;
   bool isAskingForHelp = false;
   bool isReversed = false;
 
@@ -73,10 +98,51 @@ int getPositiveInteger() {
   return ret;
 }
 
-int getNumberOfDaysToReshowCard() {
+void printSearchResults(std::string_view query, const CardsIndex& cardsIndex, const CardsDueDates& cardsDueDates) {
+  constexpr std::size_t maxShownResults = 50;
+
+  std::vector<const Card*> results = cardsIndex.search(query);
+  if (results.empty()) {
+    std::cout << "Aucune carte ne contient `" << query << "`." << std::endl;
+    return;
+  }
+
+  std::unordered_map<const Card*, std::chrono::year_month_day> dueDates;
+  std::size_t shownCount = std::min(results.size(), maxShownResults);
+  for (std::size_t i = 0; i < shownCount; ++i) {
+    dueDates.emplace(results[i], std::chrono::year_month_day{});
+  }
+  for (const auto& [card, _0, _1] : cardsDueDates.getDueCards()) {
+    if (auto it = dueDates.find(&card.get()); it != dueDates.end()) it->second = cardsDueDates.getToday();
+  }
+  for (const auto& [dueDate, card, _] : cardsDueDates.getOtherCards()) {
+    if (auto it = dueDates.find(&card.get()); it != dueDates.end()) it->second = dueDate;
+  }
+
+  std::string output;
+  for (std::size_t i = 0; i < shownCount; ++i) {
+    const std::chrono::year_month_day& dueDate = dueDates[results[i]];
+    output += std::format("{} ({})\n", results[i]->title(), dueDate.ok() ? std::format("{:%F}", dueDate) : "nouvelle carte");
+  }
+  if (results.size() > shownCount) {
+    output += std::format("... et {} autres cartes\n", results.size() - shownCount);
+  }
+  std::cout << output << std::flush;
+}
+
+// The index is only built on the first search, most sessions never search
+int getNumberOfDaysToReshowCard(std::optional<CardsIndex>& cardsIndex, const Cards& cards, const CardsDueDates& cardsDueDates) {
   int ret = -1;
   while (ret < 0) {
-    std::cout << "Dans combien de jour réafficher la carte?\n";
+    std::cout << "Dans combien de jour réafficher la carte? (/texte pour chercher une carte)\n";
+    if (std::cin.peek() == '/') {
+      std::cin.get();
+      std::string query;
+      std::getline(std::cin, query);
+      if (!cardsIndex.has_value()) cardsIndex.emplace(cards);
+      printSearchResults(query, *cardsIndex, cardsDueDates);
+      continue;
+    }
     ret = getPositiveInteger();
   }
   waitForNewline();
@@ -84,21 +150,44 @@ int getNumberOfDaysToReshowCard() {
   return ret;
 }
 
-int showCard(const Card& card, int numberOfDaysSinceLastTime, bool isReversed) {
-  std::cout << "\033[2J\033[1;1H"; // Clear screen
-  std::cout << ( isReversed ? card.secondSide() : card.firstSide() ) << std::endl;
-  if (numberOfDaysSinceLastTime > 0) {
-    std::cout << "(Montrée la dernière fois il y a " << numberOfDaysSinceLastTime << " jours)" << std::endl;
-  } else if (numberOfDaysSinceLastTime == 0) {
-    std::cout << "(Montrée la dernière fois aujourd'hui)" << std::endl;
+void showPages(const std::vector<std::string>& pages) {
+  for (std::size_t i = 0; i < pages.size(); ++i) {
+    TerminalRenderer::write(pages[i]);
+    if (i + 1 < pages.size()) waitForNewline();
+  }
+}
+
+int showCard(TerminalRenderer& renderer, const DueCard& dueCard, bool isReversed, std::optional<CardsIndex>& cardsIndex, const Cards& cards,
+    const CardsDueDates& cardsDueDates) {
+  const CardPages& pages = renderer.render(dueCard.card.get(), dueCard.numberOfDaysSinceLastTime, isReversed);
+  showPages(pages.frontPages);
+  // Prepare the next card while the user is answering
+  if (const DueCard* nextDueCard = cardsDueDates.peekNextCard(); nextDueCard != nullptr) {
+    renderer.prerender(nextDueCard->card.get(), nextDueCard->numberOfDaysSinceLastTime, isReversed);
   }
   waitForNewline();
-  std::cout << ( isReversed ? card.firstSide() : card.secondSide() ) << "\n\n";
-  return getNumberOfDaysToReshowCard();
+  showPages(pages.backPages);
+  return getNumberOfDaysToReshowCard(cardsIndex, cards, cardsDueDates);
+}
+
+std::optional<DueCardsOrder> parseDueCardsOrder(const char* name) {
+  if (!strcmp(name, "random")) return DueCardsOrder::Random;
+  if (!strcmp(name, "overdue")) return DueCardsOrder::MostOverdue;
+  if (!strcmp(name, "interval")) return DueCardsOrder::ShortestInterval;
+  if (!strcmp(name, "interleaved")) return DueCardsOrder::Interleaved;
+  return std::nullopt;
 }
 
 CommandLineArguments parseCommandLineArgument(int argc, char** argv) {
   CommandLineArguments args;
+  if (argc > 2 && !strcmp(argv[1], "search")) {
+    args.command = Command::Search;
+    args.query = argv[2];
+    argv = &argv[2]; argc -= 2;
+  } else if (argc > 1 && !strcmp(argv[1], "check")) {
+    args.command = Command::Check;
+    argv = &argv[1]; --argc;
+  }
   while (--argc) {
     argv = &argv[1];
     if (!strcmp(argv[0], "--help") || !strcmp(argv[0], "-h")) args.isAskingForHelp = true;
@@ -115,6 +204,25 @@ CommandLineArguments parseCommandLineArgument(int argc, char** argv) {
       if (count >= std::numeric_limits<unsigned int>::max() || *end != '\0') args.isAskingForHelp = true;
       args.maxNewCardCount = static_cast<unsigned int>(count);
     }
+    else if (!strcmp(argv[0], "--seed")) {
+      char* end = nullptr;
+      // `strtoull` would accept a sign and wrap negative values
+      if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
+        argv = &argv[1]; --argc;
+        errno = 0;
+        args.seed = strtoull(argv[0], &end, 10);
+      }
+      if (end == nullptr || *end != '\0' || errno == ERANGE) args.isAskingForHelp = true;
+    }
+    else if (!strcmp(argv[0], "--order")) {
+      std::optional<DueCardsOrder> order;
+      if (argc > 1) {
+        argv = &argv[1]; --argc;
+        order = parseDueCardsOrder(argv[0]);
+      }
+      if (order.has_value()) args.order = *order;
+      else args.isAskingForHelp = true;
+    }
     else if (args.cardsPath.empty()) args.cardsPath = argv[0];
     else args.cardsDueDatesPath = argv[0];
   }
@@ -123,32 +231,44 @@ CommandLineArguments parseCommandLineArgument(int argc, char** argv) {
 
 std::string getDueDatesPathFromCardsPath(const std::string& cardsPath, bool isReversed) {
   std::filesystem::path path{cardsPath};
+  std::string_view compressedExtension = compressionExtension(compressionFromPath(cardsPath));
+  if (!compressedExtension.empty()) path.replace_extension();
   std::filesystem::path directory = path.parent_path();
   std::string filename = path.stem().string();
   filename += isReversed ? "_reversed_due_dates.json" : "_due_dates.json";
+  filename += compressedExtension;
   return (directory / std::filesystem::path{filename}).string();
 }
 
 void usage(const char* executablePath) {
   std::cout << std::format(
-      "Usage: {} cards_path [cards_due_dates_path] [-r]\n"
+      "Usage: {0} cards_path [cards_due_dates_path] [-r] [--order order] [--seed seed]\n"
+      "       {0} search query cards_path [cards_due_dates_path] [-r]\n"
+      "       {0} check cards_path [cards_due_dates_path] [-r]\n"
       "    -r  flip the side of the cards when showing\n"
-      "    if `cards_due_dates_path` is not present it is made from `cards_path` by removing its extention and appending `_due_dates.json`.",
+      "    --order  order of the due cards: `random` (default), `overdue` (most overdue first),\n"
+      "             `interval` (shortest interval first) or `interleaved` (alternate reviewed and new cards)\n"
+      "    --seed  seed the shuffling of the due cards to get the same order every time\n"
+      "    search  list the cards containing `query` in their title or sides with their due date\n"
+      "    check  report every error in the cards and cards due dates files\n"
+      "    if `cards_due_dates_path` is not present it is made from `cards_path` by removing its extention and appending `_due_dates.json`.\n"
+      "    files ending with `.gz` or `.zst` are read and written compressed with gzip or zstd.",
       executablePath) << std::endl;
 }
 
 volatile sig_atomic_t gShouldExit = 0;
 
-void pickAndShowCard(CardsDueDates& cardsDueDates, bool isReversed) {
-  auto card = cardsDueDates.pickNewCard();
-  if (!card.has_value()) {
+void pickAndShowCard(TerminalRenderer& renderer, CardsDueDates& cardsDueDates, bool isReversed, std::optional<CardsIndex>& cardsIndex,
+    const Cards& cards) {
+  const DueCard* dueCard = cardsDueDates.pickNewCard();
+  if (dueCard == nullptr) {
     std::cout << "Il n'y a plus de carte à afficher!" << std::endl;
     gShouldExit = true;
     return;
   }
 
-  int nextDueTime = showCard((**card).first.get(), (**card).second, isReversed);
-  cardsDueDates.putbackCard(*card, nextDueTime);
+  int nextDueTime = showCard(renderer, *dueCard, isReversed, cardsIndex, cards, cardsDueDates);
+  cardsDueDates.putbackCard(nextDueTime);
 }
 
 void triggerExitSignalHandler([[maybe_unused]] int signalNumber) {
@@ -176,16 +296,47 @@ int main(int argc, char** argv) {
     if (args.cardsDueDatesPath.empty())
       args.cardsDueDatesPath = getDueDatesPathFromCardsPath(args.cardsPath, args.isReversed);
 
-    auto [cards, cardsDueDates] = readCardsData(args.cardsPath.c_str(), args.cardsDueDatesPath.c_str(), args.maxNewCardCount);
+    if (args.command == Command::Check) {
+      std::vector<CheckError> errors;
+      try {
+        errors = checkCardsFiles(args.cardsPath.c_str(), args.cardsDueDatesPath.c_str());
+      } catch (const std::exception& e) {
+        // A file which cannot be read must not pass the check
+        std::cout << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::string output;
+      for (const auto& [path, offset, message] : errors) {
+        output += std::format("{}:{}: {}\n", path, offset, message);
+      }
+      output += errors.empty() ? "No error found\n" : std::format("{} errors found\n", errors.size());
+      std::cout << output << std::flush;
+      return errors.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (args.command == Command::Search) {
+      Cards cards = readCards(args.cardsPath.c_str());
+      DueDatesStatistics dueDatesStatistics;
+      CardsDueDates cardsDueDates = readCardsDueDates(args.cardsDueDatesPath.c_str(), cards, dueDatesStatistics);
+      printSearchResults(args.query, CardsIndex{cards}, cardsDueDates);
+      return EXIT_SUCCESS;
+    }
+
+    std::uint64_t seed = args.seed.value_or((std::uint64_t{std::random_device{}()} << 32) | std::random_device{}());
+    auto [cards, cardsDueDates] = readCardsData(args.cardsPath.c_str(), args.cardsDueDatesPath.c_str(), args.maxNewCardCount,
+        args.order, seed);
+    std::optional<CardsIndex> cardsIndex;
 
     setupTriggerExitSignalHandler();
+    setupTerminalResizeSignalHandler();
+    TerminalRenderer renderer;
 
     std::cin.exceptions(std::istream::badbit | std::istream::eofbit);
 
     try {
       if (!gShouldExit) waitForNewline();
       while (!gShouldExit) {
-        pickAndShowCard(cardsDueDates, args.isReversed);
+        pickAndShowCard(renderer, cardsDueDates, args.isReversed, cardsIndex, cards);
       }
     } catch (const std::ios_base::failure& e) {
       if (std::cin.bad()) {
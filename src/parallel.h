@@ -0,0 +1,23 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline std::size_t getThreadCount(std::size_t workSize) {
+  return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, workSize / 4096 + 1);
+}
+
+// Call `f(threadIndex, begin, end)` on `threadCount` threads, splitting [0, count) in contiguous chunks.
+template<typename F>
+void parallelFor(std::size_t count, std::size_t threadCount, const F& f) {
+  std::vector<std::jthread> threads;
+  threads.reserve(threadCount);
+  for (std::size_t i = 0; i < threadCount; ++i) {
+    threads.emplace_back([&f, i, begin = count*i/threadCount, end = count*(i+1)/threadCount] {f(i, begin, end);});
+  }
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+// xoshiro256** seeded with splitmix64. Unlike `std::shuffle` and the standard distributions, whose algorithms are left
+// to the implementation, `randomShuffle` gives the same permutation for a given seed with every standard library.
+class RandomGenerator {
+  std::uint64_t mState[4];
+
+  static std::uint64_t rotl(std::uint64_t x, int k) {return (x << k) | (x >> (64 - k));}
+
+public:
+  using result_type = std::uint64_t;
+
+  explicit RandomGenerator(std::uint64_t seed) {
+    for (std::uint64_t& state : mState) {
+      seed += 0x9e3779b97f4a7c15;
+      std::uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      state = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() {return 0;}
+  static constexpr result_type max() {return std::numeric_limits<result_type>::max();}
+
+  result_type operator()() {
+    std::uint64_t result = rotl(mState[1] * 5, 7) * 9;
+    std::uint64_t t = mState[1] << 17;
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= t;
+    mState[3] = rotl(mState[3], 45);
+    return result;
+  }
+
+  // Uniform in [0, bound), rejecting the values that would bias the modulo
+  std::uint64_t bounded(std::uint64_t bound) {
+    std::uint64_t threshold = (0 - bound) % bound;
+    std::uint64_t value;
+    do {
+      value = (*this)();
+    } while (value < threshold);
+    return value % bound;
+  }
+};
+
+template<typename RandomIt>
+void randomShuffle(RandomIt first, RandomIt last, RandomGenerator& randomGenerator) {
+  auto count = static_cast<std::uint64_t>(std::distance(first, last));
+  for (std::uint64_t i = count; i > 1; --i) {
+    std::iter_swap(first + static_cast<std::ptrdiff_t>(i - 1), first + static_cast<std::ptrdiff_t>(randomGenerator.bounded(i)));
+  }
+}
+
+#endif
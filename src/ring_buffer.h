@@ -0,0 +1,82 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <vector>
+
+// Contiguous FIFO queue. The capacity is a power of two, and the slots not in use keep stale copies so that `T` does not
+// need to be default constructible.
+template<typename T>
+class RingBuffer {
+  std::vector<T> mStorage;
+  std::size_t mHead = 0;
+  std::size_t mSize = 0;
+
+  std::size_t slot(std::size_t index) const {return (mHead + index) & (mStorage.size() - 1);}
+
+  void grow(const T& filler) {
+    std::vector<T> storage;
+    std::size_t capacity = std::max<std::size_t>(16, mStorage.size() * 2);
+    storage.reserve(capacity);
+    for (std::size_t i = 0; i < mSize; ++i) {
+      storage.push_back(std::move(mStorage[slot(i)]));
+    }
+    storage.resize(capacity, filler);
+    mStorage.swap(storage);
+    mHead = 0;
+  }
+
+public:
+  class ConstIterator {
+    const RingBuffer* mBuffer = nullptr;
+    std::size_t mIndex = 0;
+
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = T;
+
+    ConstIterator() = default;
+    ConstIterator(const RingBuffer* buffer, std::size_t index) : mBuffer(buffer), mIndex(index) {}
+
+    const T& operator*() const {return (*mBuffer)[mIndex];}
+    const T* operator->() const {return &(*mBuffer)[mIndex];}
+    ConstIterator& operator++() {++mIndex; return *this;}
+    ConstIterator operator++(int) {ConstIterator it = *this; ++mIndex; return it;}
+    bool operator==(const ConstIterator& other) const {return mIndex == other.mIndex;}
+  };
+
+  std::size_t size() const {return mSize;}
+  bool empty() const {return mSize == 0;}
+
+  const T& operator[](std::size_t index) const {return mStorage[slot(index)];}
+  T& front() {return mStorage[mHead];}
+  const T& front() const {return mStorage[mHead];}
+
+  void push_back(const T& value) {
+    if (mSize == mStorage.size()) grow(value);
+    mStorage[slot(mSize)] = value;
+    ++mSize;
+  }
+
+  void pop_front() {
+    mHead = slot(1);
+    --mSize;
+  }
+
+  // Move the elements to the start of the storage so that they can be reordered in place.
+  std::span<T> linearize() {
+    if (mHead != 0) {
+      std::rotate(mStorage.begin(), mStorage.begin() + static_cast<std::ptrdiff_t>(mHead), mStorage.end());
+      mHead = 0;
+    }
+    return std::span<T>{mStorage.data(), mSize};
+  }
+
+  ConstIterator begin() const {return ConstIterator{this, 0};}
+  ConstIterator end() const {return ConstIterator{this, mSize};}
+};
+
+#endif
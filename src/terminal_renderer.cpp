@@ -0,0 +1,157 @@
+#include "terminal_renderer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <signal.h>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+volatile sig_atomic_t gIsTerminalResized = 0;
+
+constexpr std::string_view clearScreen = "\033[2J\033[1;1H";
+constexpr std::string_view nextPageHint = "(Entrée pour la suite)\n";
+
+TerminalSize queryTerminalSize() {
+  winsize size{};
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0) return {};
+  return {size.ws_row, size.ws_col};
+}
+
+// Split `text` at newlines and every `columns` characters, unless `columns` is 0
+void wrapLines(std::string_view text, unsigned short columns, std::vector<std::string_view>& lines) {
+  while (true) {
+    std::size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    while (columns != 0) {
+      // Count UTF-8 code points, not bytes
+      std::size_t i = 0;
+      for (unsigned short count = 0; i < line.size(); ++i) {
+        if ((static_cast<unsigned char>(line[i]) & 0xC0) != 0x80 && count++ == columns) break;
+      }
+      if (i == line.size()) break;
+      lines.push_back(line.substr(0, i));
+      line.remove_prefix(i);
+    }
+    lines.push_back(line);
+    if (newline == std::string_view::npos) return;
+    text.remove_prefix(newline + 1);
+  }
+}
+
+void addPages(std::vector<std::string>& pages, const std::vector<std::string_view>& lines, std::size_t pageHeight) {
+  for (std::size_t begin = 0; begin < lines.size();) {
+    std::size_t end = begin + std::min(pageHeight, lines.size() - begin);
+    std::string page{clearScreen};
+    for (std::size_t i = begin; i < end; ++i) {
+      page += lines[i];
+      page += '\n';
+    }
+    if (end != lines.size()) page += nextPageHint;
+    pages.push_back(std::move(page));
+    begin = end;
+  }
+}
+
+void triggerTerminalResizedSignalHandler([[maybe_unused]] int signalNumber) {
+  gIsTerminalResized = 1;
+}
+
+} // namespace
+
+TerminalRenderer::TerminalRenderer() : mSize(queryTerminalSize()) {}
+
+void TerminalRenderer::updateSize() {
+  if (!gIsTerminalResized) return;
+  gIsTerminalResized = 0;
+  mSize = queryTerminalSize();
+}
+
+bool TerminalRenderer::isRendered(const CardPages& pages, const Card& card, int numberOfDaysSinceLastTime, bool isReversed) const {
+  return pages.card == &card && pages.numberOfDaysSinceLastTime == numberOfDaysSinceLastTime
+    && pages.isReversed == isReversed && pages.size == mSize;
+}
+
+void TerminalRenderer::renderInto(CardPages& pages, const Card& card, int numberOfDaysSinceLastTime, bool isReversed) const {
+  pages.card = &card;
+  pages.numberOfDaysSinceLastTime = numberOfDaysSinceLastTime;
+  pages.isReversed = isReversed;
+  pages.size = mSize;
+  pages.frontPages.clear();
+  pages.backPages.clear();
+
+  // Keep a line for the next page hint and one for the cursor
+  std::size_t pageHeight = (mSize.rows >= 3) ? mSize.rows - 2u : std::numeric_limits<std::size_t>::max();
+
+  std::vector<std::string_view> lines;
+  wrapLines(isReversed ? card.secondSide() : card.firstSide(), mSize.columns, lines);
+  std::string lastTimeShown;
+  if (numberOfDaysSinceLastTime > 0) {
+    lastTimeShown = std::format("(Montrée la dernière fois il y a {} jours)", numberOfDaysSinceLastTime);
+  } else if (numberOfDaysSinceLastTime == 0) {
+    lastTimeShown = "(Montrée la dernière fois aujourd'hui)";
+  }
+  if (!lastTimeShown.empty()) wrapLines(lastTimeShown, mSize.columns, lines);
+  std::size_t frontLineCount = lines.size();
+  addPages(pages.frontPages, lines, pageHeight);
+
+  lines.clear();
+  wrapLines(isReversed ? card.firstSide() : card.secondSide(), mSize.columns, lines);
+  // The back is shown below the front when it fits with the line of the user's answer, a blank line and the prompt
+  if (pages.frontPages.size() == 1 && (mSize.rows == 0 || frontLineCount + lines.size() + 4 <= mSize.rows)) {
+    std::string page;
+    for (std::string_view line : lines) {
+      page += line;
+      page += '\n';
+    }
+    page += '\n';
+    pages.backPages.push_back(std::move(page));
+  } else {
+    addPages(pages.backPages, lines, pageHeight);
+  }
+}
+
+const CardPages& TerminalRenderer::render(const Card& card, int numberOfDaysSinceLastTime, bool isReversed) {
+  updateSize();
+  if (isRendered(mNext, card, numberOfDaysSinceLastTime, isReversed)) {
+    std::swap(mCurrent, mNext);
+  } else if (!isRendered(mCurrent, card, numberOfDaysSinceLastTime, isReversed)) {
+    renderInto(mCurrent, card, numberOfDaysSinceLastTime, isReversed);
+  }
+  return mCurrent;
+}
+
+void TerminalRenderer::prerender(const Card& card, int numberOfDaysSinceLastTime, bool isReversed) {
+  updateSize();
+  if (!isRendered(mNext, card, numberOfDaysSinceLastTime, isReversed)) {
+    renderInto(mNext, card, numberOfDaysSinceLastTime, isReversed);
+  }
+}
+
+void TerminalRenderer::write(std::string_view frame) {
+  std::cout.flush();
+  while (!frame.empty()) {
+    ssize_t count = ::write(STDOUT_FILENO, frame.data(), frame.size());
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error(std::format("Failed to write to the terminal ({})!", std::strerror(errno)));
+    }
+    frame.remove_prefix(static_cast<std::size_t>(count));
+  }
+}
+
+void setupTerminalResizeSignalHandler() {
+  struct sigaction sa{};
+  sa.sa_handler = &triggerTerminalResizedSignalHandler;
+  // Do not interrupt the reads from the standard input
+  sa.sa_flags = SA_RESTART;
+  if (sigaction(SIGWINCH, &sa, nullptr)) {
+    throw std::runtime_error("Failed to setup signal handler!");
+  }
+}
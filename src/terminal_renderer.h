@@ -0,0 +1,51 @@
+#ifndef TERMINAL_RENDERER_H
+#define TERMINAL_RENDERER_H
+
+#include "card.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct TerminalSize {
+  // 0 when unknown, e.g. when the output is not a terminal
+  unsigned short rows = 0;
+  unsigned short columns = 0;
+
+  bool operator==(const TerminalSize&) const = default;
+};
+
+struct CardPages {
+  const Card* card = nullptr;
+  int numberOfDaysSinceLastTime = 0;
+  bool isReversed = false;
+  TerminalSize size;
+  std::vector<std::string> frontPages;
+  std::vector<std::string> backPages;
+};
+
+// Compose every screen of a card in one buffer, emitted with a single `write()`. Sides too long for the terminal are
+// split in pages.
+class TerminalRenderer {
+  TerminalSize mSize;
+  CardPages mCurrent;
+  CardPages mNext;
+
+  void updateSize();
+  bool isRendered(const CardPages& pages, const Card& card, int numberOfDaysSinceLastTime, bool isReversed) const;
+  void renderInto(CardPages& pages, const Card& card, int numberOfDaysSinceLastTime, bool isReversed) const;
+
+public:
+  TerminalRenderer();
+
+  // The pages stay valid until the next call to `render`.
+  const CardPages& render(const Card& card, int numberOfDaysSinceLastTime, bool isReversed);
+  // Render the card expected to be shown next, so that `render` only has to swap it in.
+  void prerender(const Card& card, int numberOfDaysSinceLastTime, bool isReversed);
+
+  static void write(std::string_view frame);
+};
+
+void setupTerminalResizeSignalHandler();
+
+#endif